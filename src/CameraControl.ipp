@@ -0,0 +1,365 @@
+#include <regex>
+#include <string>
+#include "HTTPClient.h"
+#include "tinyxml2.h"
+#include "libb64/cencode.h"
+#include "libb64/cdecode.h"
+
+// Definitions of CameraControl. Included from CameraControl.h.
+
+namespace camera_control_detail {
+constexpr const char* XMLDeclaration = R"(<?xml version="1.0" encoding="UTF-8"?>)";
+
+template <int N>
+uint8_t * GenerateNonce(){
+  static uint8_t nonce[N];
+  for(int i=0;i<N;i++){
+    nonce[i] = (uint8_t)random();
+  }
+  return nonce;
+}
+
+// obuf must have 20 bytes space.
+inline bool calcSHA1(uint8_t * ibuf, unsigned int ilen, uint8_t * obuf){
+  auto olen = mbedtls_md(mbedtls_md_info_from_type(MBEDTLS_MD_SHA1), (const unsigned char *)ibuf, ilen, (unsigned char*)obuf);
+  return olen == 20;
+}
+
+// Follow child elements by names. Return nullptr if an element is missing.
+inline const tinyxml2::XMLElement * FindElement(const tinyxml2::XMLElement * elem){
+  return elem;
+}
+
+template <class... Names>
+const tinyxml2::XMLElement * FindElement(const tinyxml2::XMLElement * elem, const char * name, Names... names){
+  return elem ? FindElement(elem->FirstChildElement(name), names...) : nullptr;
+}
+
+template <class Policy>
+const tinyxml2::XMLElement * FindBody(const tinyxml2::XMLDocument & doc){
+  return FindElement(doc.FirstChildElement(Policy::Envelope), Policy::Body);
+}
+
+// Return path part of XAddr (e.g. "onvif/service" of "http://192.168.1.63:2020/onvif/service")
+inline String ExtractPath(const tinyxml2::XMLElement * xaddr){
+  if(!xaddr || !xaddr->GetText()){
+    return String();
+  }
+  static const std::regex pattern(R"(http://(.*?)/(.*))");
+  std::string fullpath(xaddr->GetText());
+  std::smatch match;
+  std::regex_match(fullpath, match, pattern);
+
+  if(match.size() != 3){
+    return String();
+  }
+  return String(match[2].str().c_str());
+}
+
+// Return false if elem is missing or doesn't have a number.
+inline bool ExtractFloat(const tinyxml2::XMLElement * elem, float * value){
+  return elem && elem->QueryFloatText(value) == tinyxml2::XML_SUCCESS;
+}
+
+} // namespace camera_control_detail
+
+
+template <class Policy>
+CameraControl<Policy>::CameraControl(IPAddress tc70, String username, String password){
+  m_tc70 = tc70;
+  m_username = username;
+  m_password = password;
+}
+template <class Policy>
+CameraControl<Policy>::~CameraControl(){}
+
+template <class Policy>
+String CameraControl<Policy>::Request(String uri, String payload){
+  HTTPClient http; 
+  http.begin(m_tc70.toString(), ONVIF_PORT, uri);
+  http.addHeader("Content-Type", R"(application/soap+xml; charset=utf-8;)");
+
+  auto status = http.POST(payload);
+  if(status != HTTP_CODE_OK){
+    http.end();
+    USBSerial.printf("http status: %d\r\n", status);
+    return String();
+  }
+
+  auto response = http.getString();
+  http.end();
+  return response;
+}
+
+template <class Policy>
+typename CameraControl<Policy>::SecurityParameters CameraControl<Policy>::GenerateSecurityParameters(String plain_password){
+  struct tm current;
+  getLocalTime(&current);
+
+  char buf[64];
+  strftime(buf, 64, "%Y-%m-%dT%H:%M:%S%z", &current);
+
+  SecurityParameters sp;
+  sp.created = String(buf);
+
+  auto nonce = camera_control_detail::GenerateNonce<NONCE_LENGTH>();
+  memcpy(sp.nonce, nonce, NONCE_LENGTH);
+
+  uint8_t nonce_created_password_buf[128];
+  uint8_t* dst1 = nonce_created_password_buf;
+  uint8_t* dst2 = nonce_created_password_buf + NONCE_LENGTH;
+  uint8_t* dst3 = nonce_created_password_buf + NONCE_LENGTH + sp.created.length();
+  memcpy(dst1, nonce, NONCE_LENGTH);
+  memcpy(dst2, sp.created.c_str(), sp.created.length());
+  memcpy(dst3, plain_password.c_str(), plain_password.length());
+
+  int length = NONCE_LENGTH + sp.created.length() + plain_password.length();
+
+  camera_control_detail::calcSHA1(nonce_created_password_buf, length, sp.password_digest);
+
+  return sp;
+}
+
+//------------------------------------------------
+// ONVIF Commands
+
+template <class Policy>
+String CameraControl<Policy>::GetCapabilities(const String & uri){
+  auto soap_header = PackWebServiceSecurity(m_username, m_password);
+  auto soap_body   = PackGetCapabitlities();
+  auto payload     = String(camera_control_detail::XMLDeclaration) + PackSoapEnvelope(soap_header, soap_body);
+  return Request(uri, payload);
+}
+
+template <class Policy>
+String CameraControl<Policy>::GetProfiles(const String & uri){
+  auto soap_header = PackWebServiceSecurity(m_username, m_password);
+  auto soap_body   = PackGetProfiles();
+  auto payload     = String(camera_control_detail::XMLDeclaration) + PackSoapEnvelope(soap_header, soap_body);
+  return Request(uri, payload);
+}
+
+template <class Policy>
+String CameraControl<Policy>::GetConfigurationOptions(const String & uri, const String & token){
+  auto soap_header = PackWebServiceSecurity(m_username, m_password);
+  auto soap_body   = PackGetConfigurationOptions(token);
+  auto payload     = String(camera_control_detail::XMLDeclaration) + PackSoapEnvelope(soap_header, soap_body);
+  return Request(uri, payload);
+}
+
+template <class Policy>
+String CameraControl<Policy>::GetStatus(const String & uri, const String & profile){
+  auto soap_header = PackWebServiceSecurity(m_username, m_password);
+  auto soap_body   = PackGetStatus(profile);
+  auto payload     = String(camera_control_detail::XMLDeclaration) + PackSoapEnvelope(soap_header, soap_body);
+  return Request(uri, payload);
+}
+
+template <class Policy>
+String CameraControl<Policy>::AbsoluteMove(const String & uri, const String & profile, float pan, float tilt, float vx, float vy){
+  static_assert(Policy::SupportsAbsoluteMove, "AbsoluteMove is not supported by this camera");
+  auto soap_header = PackWebServiceSecurity(m_username, m_password);
+  auto soap_body   = PackAbsoluteMove(profile, pan, tilt, vx, vy);
+  auto payload     = String(camera_control_detail::XMLDeclaration) + PackSoapEnvelope(soap_header, soap_body);
+  return Request(uri, payload);
+}
+
+//------------------------------------------------
+// Pack functions
+
+template <class Policy>
+String CameraControl<Policy>::PackSoapEnvelope(const String & header, const String & body){
+  return
+  String(R"(<soapenv:Envelope xmlns:soapenv="http://www.w3.org/2003/05/soap-envelope">)") +
+  String(  R"(<soapenv:Header>)")  +
+             header                +
+  String(  R"(</soapenv:Header>)") +
+  String(  R"(<soapenv:Body>)")    +
+             body                  +
+  String(  R"(</soapenv:Body>)")   +
+  String(R"(</soapenv:Envelope>)");
+}
+
+template <class Policy>
+String CameraControl<Policy>::PackWebServiceSecurity(String username, String password){
+  auto sp = GenerateSecurityParameters(password);
+
+  char nonce_b64[64];
+  auto nonce_b64_len = base64_encode_chars((const char *)sp.nonce, NONCE_LENGTH, nonce_b64);
+  char password_digest_b64[64];
+  auto password_digest_b64_len = base64_encode_chars((const char *)sp.password_digest, SHA1_LENGTH, password_digest_b64);
+
+  return
+  String(R"(<wss:Security xmlns:wss="http://docs.oasis-open.org/wss/2004/01/oasis-200401-wss-wssecurity-secext-1.0.xsd">)") +
+  String(  R"(<wss:UsernameToken>)" ) +
+  String(    R"(<wss:Username>)"    ) +
+               username               +
+  String(    R"(</wss:Username>)"   ) +
+  String(    R"(<wss:Password Type="http://docs.oasis-open.org/wss/2004/01/oasis-200401-wss-username-token-profile-1.0#PasswordDigest">)") +
+  String(      password_digest_b64  ) +
+  String(    R"(</wss:Password>)"   ) +
+  String(    R"(<wss:Nonce EncodingType="http://docs.oasis-open.org/wss/2004/01/oasis-200401-wss-soap-message-security-1.0#Base64Binary">)") +
+  String(      nonce_b64            ) +
+  String(    R"(</wss:Nonce>)"      ) +
+  String(    R"(<wsu:Created xmlns:wsu="http://docs.oasis-open.org/wss/2004/01/oasis-200401-wss-wssecurity-utility-1.0.xsd">)") +
+               sp.created             +
+  String(    R"(</wsu:Created>)"    ) +
+  String(  R"(</wss:UsernameToken>)") +
+  String(R"(</wss:Security>)"       );
+}
+
+template <class Policy>
+String CameraControl<Policy>::PackGetCapabitlities(){
+  return
+  String(R"(<GetCapabilities xmlns="http://www.onvif.org/ver10/device/wsdl">)") +
+  String(  R"(<Category>)" ) +
+  String(    "All"         ) +
+  String(  R"(</Category>)") +
+  String(R"(</GetCapabilities>)");
+}
+
+template <class Policy>
+String CameraControl<Policy>::PackAbsoluteMove(const String & proftoken, float pan, float tilt, float vx, float vy){
+  String position = String(" x=\"") + String(pan)  + String("\" y=\"") + String(tilt)  + String("\" ");
+  String velocity = String(" x=\"") + String(vx) + String("\" y=\"") + String(vy) + String("\" ");
+
+  return
+  String(R"(<AbsoluteMove xmlns="http://www.onvif.org/ver20/ptz/wsdl">)") +
+  String(  R"(<ProfileToken>)" ) +
+             proftoken           +
+  String(  R"(</ProfileToken>)") +
+  String(  R"(<Position>)"     ) +
+  String(    R"(<PanTilt xmlns="http://www.onvif.org/ver10/schema" space="http://www.onvif.org/ver10/tptz/PanTiltSpaces/PositionGenericSpace")") +
+               position          +
+  String(    R"(/>)"           ) +
+  String(  R"(</Position>)"    ) +
+  String(  R"(<Speed>)"        ) +
+  String(    R"(<PanTilt xmlns="http://www.onvif.org/ver10/schema" space="http://www.onvif.org/ver10/tptz/PanTiltSpaces/GenericSpeedSpace")") +
+               velocity          +
+  String(    R"(/>)"           ) +
+  String(  R"(</Speed>)"       ) +
+  String(R"(</AbsoluteMove>)"  );
+}
+
+template <class Policy>
+String CameraControl<Policy>::PackGetProfiles(){
+  return String(R"(<ns0:GetProfiles xmlns:ns0="http://www.onvif.org/ver10/media/wsdl"/>)");
+}
+
+template <class Policy>
+String CameraControl<Policy>::PackGetConfigurationOptions(const String & ptztoken){
+  return
+  String(R"(<ns0:GetConfigurationOptions xmlns:ns0="http://www.onvif.org/ver20/ptz/wsdl">)") +
+  String(  R"(<ns0:ConfigurationToken>)"    ) +
+                ptztoken                      +
+  String(  R"(</ns0:ConfigurationToken>)"   ) +
+  String(R"(</ns0:GetConfigurationOptions>)");
+}
+
+template <class Policy>
+String CameraControl<Policy>::PackGetStatus(const String & proftoken){
+  return
+  String(R"(<ns0:GetStatus xmlns:ns0="http://www.onvif.org/ver20/ptz/wsdl">)") +
+  String(  R"(<ns0:ProfileToken>)"  ) +
+             proftoken                +
+  String(  R"(</ns0:ProfileToken>)" ) +
+  String(R"(</ns0:GetStatus>)"      );
+}
+
+//------------------------------------------------
+// Extract functions
+
+template <class Policy>
+typename CameraControl<Policy>::UriList CameraControl<Policy>::ExtractUris(const String & capabilities){
+  using namespace camera_control_detail;
+  tinyxml2::XMLDocument doc;
+  auto err = doc.Parse(capabilities.c_str());
+  if(err != tinyxml2::XML_SUCCESS){
+    return UriList();
+  }
+
+  auto caps = FindElement(FindBody<Policy>(doc), Policy::GetCapabilitiesResponse, Policy::Capabilities);
+  if(!caps){
+    return UriList();
+  }
+
+  UriList uris;
+  uris.media  = ExtractPath(FindElement(caps, Policy::Media,  Policy::XAddr));
+  uris.events = ExtractPath(FindElement(caps, Policy::Events, Policy::XAddr));
+  uris.ptz    = ExtractPath(FindElement(caps, Policy::PTZ,    Policy::XAddr));
+  return uris;
+}
+
+template <class Policy>
+typename CameraControl<Policy>::Profile CameraControl<Policy>::ExtractFirstProfile(const String & profiles){
+  using namespace camera_control_detail;
+  tinyxml2::XMLDocument doc;
+  auto err = doc.Parse(profiles.c_str());
+  if(err != tinyxml2::XML_SUCCESS){
+    return Profile();
+  }
+
+  auto doc_profile = FindElement(FindBody<Policy>(doc), Policy::GetProfilesResponse, Policy::Profiles);
+  if(!doc_profile){
+    return Profile();
+  }
+
+  Profile prof;
+  prof.proftoken = doc_profile->Attribute("token");
+  auto ptz = FindElement(doc_profile, Policy::PTZConfiguration);
+  if(ptz){
+    prof.ptztoken = ptz->Attribute("token");
+  }
+
+  return prof;
+}
+
+template <class Policy>
+typename CameraControl<Policy>::PTSpace CameraControl<Policy>::ExtractAbsolutePTSpace(const String & configuration_options){
+  using namespace camera_control_detail;
+  tinyxml2::XMLDocument doc;
+  auto err = doc.Parse(configuration_options.c_str());
+  if(err != tinyxml2::XML_SUCCESS){
+    return PTSpace();
+  }
+
+  auto doc_space = FindElement(FindBody<Policy>(doc), Policy::GetConfigurationOptionsResponse, Policy::PTZConfigurationOptions, Policy::Spaces);
+  auto abs_space = FindElement(doc_space, Policy::AbsolutePanTiltPositionSpace);
+  if(!abs_space){
+    return PTSpace();
+  }
+
+  auto abs_x = FindElement(abs_space, Policy::XRange);
+  auto abs_y = FindElement(abs_space, Policy::YRange);
+  auto spd_x = FindElement(doc_space, Policy::PanTiltSpeedSpace, Policy::XRange);
+  PTSpace pt;
+  ExtractFloat(FindElement(abs_x, Policy::Min), &pt.PanMin);
+  ExtractFloat(FindElement(abs_x, Policy::Max), &pt.PanMax);
+  ExtractFloat(FindElement(abs_y, Policy::Min), &pt.TiltMin);
+  ExtractFloat(FindElement(abs_y, Policy::Max), &pt.TiltMax);
+  ExtractFloat(FindElement(spd_x, Policy::Min), &pt.SpeedMin);
+  ExtractFloat(FindElement(spd_x, Policy::Max), &pt.SpeedMax);
+
+  return pt;
+}
+
+template <class Policy>
+typename CameraControl<Policy>::PTPosition CameraControl<Policy>::ExtractAbsolutePosition(const String & status){
+  using namespace camera_control_detail;
+  tinyxml2::XMLDocument doc;
+  auto err = doc.Parse(status.c_str());
+  if(err != tinyxml2::XML_SUCCESS){
+    return PTPosition();
+  }
+
+  auto doc_pt = FindElement(FindBody<Policy>(doc), Policy::GetStatusResponse, Policy::PTZStatus, Policy::Position, Policy::PanTilt);
+  if(!doc_pt){
+    return PTPosition();
+  }
+
+  PTPosition pt;
+  doc_pt->QueryFloatAttribute("x", &pt.pan);
+  doc_pt->QueryFloatAttribute("y", &pt.tilt);
+
+  return pt;
+}
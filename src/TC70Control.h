@@ -1,120 +1,58 @@
-// This class controls TP-Link TC70 network camera by ONVIF - PTZ protocol.
-// This class transmits XML formatted packets to/from a camera through HTTP POST method.
+// Policy for TP-Link TC70 network camera.
 //
 // FYI: TP-Link TC70 Range of Motion
 // Pan 360 deg.
 // Tilt 114 deg.
-//
-// Notes:
-// This class doesn't work with generic ONVIF cameras because xml parser ignores XML namespaces.
-//
-// Usage:
-// 1. Create an instance
-//   TC70Control tc70control(tc70_ipaddr, tc70_username, tc70_password);
-// 2. Collect Information
-//   auto capabilities = tc70control.GetCapabilities();
-//   auto uris         = tc70control.ExtractUris(capabilities);
-//   auto profiles     = tc70control.GetProfiles(uris.media);
-//   auto profile      = tc70control.ExtractFirstProfile(profiles);
-//   auto conf_options = tc70control.GetConfigurationOptions(uris.ptz, profile.ptztoken);
-//   auto ptspace      = tc70control.ExtractAbsolutePTSpace(conf_options);
-// 3. (Optional) Get Current Position
-//   auto status       = tc70control.GetStatus(uris.ptz, profile.proftoken);
-//   auto current      = tc70control.ExtractAbsolutePosition(status);
-// 4. Move
-//   auto pan          = - pan_deg / TC70Control::PanRange_deg * (ptspace.PanMax - ptspace.PanMin);
-//   pan               = pan > ptspace.PanMax ? ptspace.PanMax ? pan < ptspace.PanMin ? ptspace.PanMin : pan;
-//   auto tilt         = tilt_deg / TC70Control::TiltRange_deg * (ptspace.TiltMax - ptspace.TiltMin);
-//   tilt              = tilt > ptspace.TiltMax ? ptspace.TiltMax ? tilt < ptspace.TiltMin ? ptspace.TiltMin : tilt;
-//   auto response     = tc70control.AbsoluteMove(uris.ptz, profile.proftoken, pan, tilt);
 
-#include <Arduino.h>
+#pragma once
+#include "CameraControl.h"
 
-class TC70Control {
-public:
+struct TC70Policy {
   static constexpr float PanRange_deg = 360.0f;
   static constexpr float TiltRange_deg = 114.0f;
 
   static constexpr uint16_t ONVIF_PORT = 2020;
-  static constexpr int SHA1_LENGTH = 20; // SHA-1 must return 20 bytes result.
-  static constexpr int NONCE_LENGTH = 16;
-
-  struct PTSpace {
-    float PanMin   = 0;
-    float PanMax   = 0;
-    float TiltMin  = 0;
-    float TiltMax  = 0;
-    float SpeedMin = 0;
-    float SpeedMax = 0;
-  };
-
-  struct PTPosition {
-    float pan = 0;
-    float tilt = 0;
-
-    PTPosition(float pan_in = 0, float tilt_in = 0){
-      pan = pan_in;
-      tilt = tilt_in;
-    }
-  };
-
-  struct Profile {
-    String proftoken;
-    String ptztoken;
-  };
-
-  struct UriList {
-    String media;
-    String ptz;
-    String events;
-  };
-  
-  TC70Control() = delete;
-  TC70Control(IPAddress tc70, String username, String password);
-  ~TC70Control();
-
-private:
-  struct SecurityParameters {
-    String  created; // ISO-8601 formatted time
-    uint8_t nonce[NONCE_LENGTH];
-    uint8_t password_digest[SHA1_LENGTH];
-  };
-  SecurityParameters GenerateSecurityParameters(String plain_password);
-
-  String Request(String uri, String payload);
 
-  String PackSoapEnvelope(const String & header, const String & body);
-  String PackWebServiceSecurity(String username, String password);
-  String PackGetCapabitlities();
-  String PackGetProfiles();
-  String PackGetConfigurationOptions(const String & ptztoken);
-  String PackGetStatus(const String & proftoken);
-  String PackAbsoluteMove(const String & proftoken, float x, float y, float vx, float vy);
-
-public:
-  // Response of GetCapabilities contains URIs for each service
-  String GetCapabilities(const String & uri = "onvif/device_service");
-
-  // Profile contains PTZConfiguration
-  String GetProfiles(const String & uri_media);
-
-  // Response of GetConfigurationOptions contains PTZ spaces.
-  String GetConfigurationOptions(const String & uri_ptz, const String & ptztoken);
-
-  // Response of GetStatus contains current position.
-  String GetStatus(const String & uri_ptz, const String & proftoken);
-
-  String AbsoluteMove(const String & uri_ptz, const String & proftoken, float pan, float tilt, float vx = 1.0, float vy = 1.0);
-
-// Extract functions should be static
-  UriList ExtractUris(const String & capabilities);
-  Profile ExtractFirstProfile(const String & profiles);
-  PTSpace ExtractAbsolutePTSpace(const String & configuration_options);
-  PTPosition ExtractAbsolutePosition(const String & status);
-
-private:
-  IPAddress m_tc70;
-  String m_username;
-  String m_password;
+  static constexpr bool SupportsAbsoluteMove = true;
+
+  // Envelope/Body
+  static constexpr const char* Envelope = "SOAP-ENV:Envelope";
+  static constexpr const char* Body     = "SOAP-ENV:Body";
+
+  // GetCapabilities: Body/GetCapabilitiesResponse/Capabilities/{Media,Events,PTZ}/XAddr
+  static constexpr const char* GetCapabilitiesResponse = "tds:GetCapabilitiesResponse";
+  static constexpr const char* Capabilities            = "tds:Capabilities";
+  static constexpr const char* Media                   = "tt:Media";
+  static constexpr const char* Events                  = "tt:Events";
+  static constexpr const char* PTZ                     = "tt:PTZ";
+  static constexpr const char* XAddr                   = "tt:XAddr";
+
+  // GetProfiles: Body/GetProfilesResponse/Profiles/PTZConfiguration
+  static constexpr const char* GetProfilesResponse = "trt:GetProfilesResponse";
+  static constexpr const char* Profiles            = "trt:Profiles";
+  static constexpr const char* PTZConfiguration    = "tt:PTZConfiguration";
+
+  // GetConfigurationOptions:
+  //   Body/GetConfigurationOptionsResponse/PTZConfigurationOptions/Spaces/
+  //     {AbsolutePanTiltPositionSpace,PanTiltSpeedSpace}/{XRange,YRange}/{Min,Max}
+  static constexpr const char* GetConfigurationOptionsResponse = "tptz:GetConfigurationOptionsResponse";
+  static constexpr const char* PTZConfigurationOptions         = "tptz:PTZConfigurationOptions";
+  static constexpr const char* Spaces                          = "tt:Spaces";
+  static constexpr const char* AbsolutePanTiltPositionSpace    = "tt:AbsolutePanTiltPositionSpace";
+  static constexpr const char* PanTiltSpeedSpace               = "tt:PanTiltSpeedSpace";
+  static constexpr const char* XRange                          = "tt:XRange";
+  static constexpr const char* YRange                          = "tt:YRange";
+  static constexpr const char* Min                             = "tt:Min";
+  static constexpr const char* Max                             = "tt:Max";
+
+  // GetStatus: Body/GetStatusResponse/PTZStatus/Position/PanTilt
+  static constexpr const char* GetStatusResponse = "tptz:GetStatusResponse";
+  static constexpr const char* PTZStatus         = "tptz:PTZStatus";
+  static constexpr const char* Position          = "tt:Position";
+  static constexpr const char* PanTilt           = "tt:PanTilt";
 };
 
+using TC70Control = CameraControl<TC70Policy>;
+
+// Instantiated once in TC70Control.cpp
+extern template class CameraControl<TC70Policy>;
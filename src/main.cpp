@@ -90,14 +90,17 @@ bool initTC70() {
   auto capabilities = tc70control.GetCapabilities();
   if(capabilities.isEmpty()){ return false; }
   g_uris = tc70control.ExtractUris(capabilities);
+  if(!g_uris.IsValid()){ return false; }
 
   auto profiles = tc70control.GetProfiles(g_uris.media);
   if(profiles.isEmpty()){ return false; }
   g_prof = tc70control.ExtractFirstProfile(profiles);
+  if(!g_prof.IsValid()){ return false; }
 
   auto configuration_options = tc70control.GetConfigurationOptions(g_uris.ptz, g_prof.ptztoken);
   if(configuration_options.isEmpty()){ return false; }
   g_ptspace = tc70control.ExtractAbsolutePTSpace(configuration_options);
+  if(!g_ptspace.IsValid()){ return false; }
 
   auto status = tc70control.GetStatus(g_uris.ptz, g_prof.proftoken);
   if(status.isEmpty()){ return false; }